@@ -0,0 +1,288 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <fstream>
+#include <cstdio>
+#include <utility>
+#include <algorithm>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+#include "InvertedIndex.h"
+#include "SearchServer.h"
+#include "SearchEngine.h"
+#include "DocumentStore.h"
+
+using namespace std;
+
+namespace {
+
+size_t residentBytes() {
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+#if defined(__linux__)
+    ifstream statm("/proc/self/statm");
+    size_t total = 0, resident = 0;
+    statm >> total >> resident;
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+}
+
+double toMiB(size_t bytes) {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+vector<string> makeVocabulary(size_t size, mt19937& rng) {
+    uniform_int_distribution<int> letter('a', 'z');
+    uniform_int_distribution<size_t> length(3, 10);
+    vector<string> vocabulary(size);
+    for (auto& word : vocabulary) {
+        word.resize(length(rng));
+        for (auto& c : word) c = static_cast<char>(letter(rng));
+    }
+    return vocabulary;
+}
+
+vector<string> makeCorpus(size_t doc_count, size_t words_per_doc,
+                          const vector<string>& vocabulary, mt19937& rng) {
+    // Zipf-like word distribution so that posting lengths are skewed as in real text.
+    vector<double> weights(vocabulary.size());
+    for (size_t i = 0; i < weights.size(); ++i) weights[i] = 1.0 / static_cast<double>(i + 1);
+    discrete_distribution<size_t> pick(weights.begin(), weights.end());
+
+    vector<string> docs(doc_count);
+    for (auto& doc : docs) {
+        for (size_t w = 0; w < words_per_doc; ++w) {
+            if (w) doc.push_back(' ');
+            doc += vocabulary[pick(rng)];
+        }
+    }
+    return docs;
+}
+
+void benchDocumentStore(const vector<string>& corpus) {
+    cout << "=== Document store ===" << endl;
+
+    size_t corpus_bytes = 0;
+    for (const auto& doc : corpus) corpus_bytes += doc.size();
+
+    size_t rss_start = residentBytes();
+    size_t rss_retained = 0;
+    {
+        vector<string> retained = corpus;
+        InvertedIndex index;
+        index.UpdateDocumentBase(retained);
+        rss_retained = residentBytes();
+    }
+
+    const string store_path = "bench_documents.store";
+    DocumentStore::Build(store_path, corpus);
+
+    vector<string> docs = corpus;
+    InvertedIndex index;
+    index.UpdateDocumentBase(move(docs));
+    size_t rss_index_only = residentBytes();
+
+    ifstream store_file(store_path, ios::binary | ios::ate);
+    size_t store_bytes = static_cast<size_t>(store_file.tellg());
+
+    size_t read_bytes = 0;
+    auto start = chrono::steady_clock::now();
+    {
+        DocumentStore store(store_path);
+        for (size_t i = 0; i < store.size(); ++i) {
+            read_bytes += store.GetDocument(i).size();
+        }
+    }
+    auto elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    remove(store_path.c_str());
+
+    cout << fixed << setprecision(2);
+    cout << "corpus: " << corpus.size() << " docs, " << toMiB(corpus_bytes) << " MiB" << endl;
+    cout << "RSS index + retained texts: " << toMiB(rss_retained - rss_start) << " MiB" << endl;
+    cout << "RSS index only:             " << toMiB(rss_index_only - rss_start) << " MiB" << endl;
+    cout << "store on disk: " << toMiB(store_bytes) << " MiB ("
+         << 100.0 * static_cast<double>(store_bytes) / static_cast<double>(corpus_bytes) << "% of raw)" << endl;
+    cout << "store full scan: " << toMiB(read_bytes) << " MiB in " << elapsed << " ms" << endl;
+}
+
+vector<string> makeQueries(size_t count, const vector<string>& vocabulary, mt19937& rng) {
+    // Mostly frequent head terms, which produce the long posting lists.
+    uniform_int_distribution<size_t> head(0, 50);
+    uniform_int_distribution<size_t> any(0, vocabulary.size() - 1);
+    uniform_int_distribution<size_t> length(1, 4);
+    vector<string> queries(count);
+    for (auto& query : queries) {
+        size_t words = length(rng);
+        for (size_t w = 0; w < words; ++w) {
+            if (w) query.push_back(' ');
+            query += vocabulary[w + 1 < words ? head(rng) : any(rng)];
+        }
+    }
+    return queries;
+}
+
+void printLatency(const string& label, const SearchStats& stats) {
+    cout << label << ": exceeded " << stats.budget_exceeded << "/" << stats.partial.size()
+         << ", p50 " << stats.LatencyPercentile(50) << " ms, p95 " << stats.LatencyPercentile(95)
+         << " ms, p99 " << stats.LatencyPercentile(99) << " ms, max " << stats.LatencyPercentile(100) << " ms" << endl;
+}
+
+void benchQueryBudget(const vector<string>& corpus, const vector<string>& queries) {
+    cout << "=== Query budget ===" << endl;
+
+    InvertedIndex index;
+    index.UpdateDocumentBase(corpus);
+
+    {
+        SearchServer server(index);
+        server.search(queries);
+        printLatency("unbounded", server.GetLastStats());
+    }
+    for (int timeout_ms : {5, 1}) {
+        SearchServer server(index);
+        SearchBudget budget;
+        budget.query_timeout = chrono::milliseconds(timeout_ms);
+        server.search(queries, budget);
+        printLatency("timeout " + to_string(timeout_ms) + " ms", server.GetLastStats());
+    }
+    {
+        SearchServer server(index);
+        SearchBudget budget;
+        budget.query_work_limit = 10000;
+        server.search(queries, budget);
+        printLatency("work 10000", server.GetLastStats());
+    }
+}
+
+template <typename Index>
+void benchVariant(const string& label, const vector<string>& corpus, const vector<string>& queries) {
+    size_t rss_start = residentBytes();
+    Index index;
+    index.UpdateDocumentBase(corpus);
+    size_t rss_index = residentBytes();
+
+    BasicSearchServer<Index> server(index);
+    auto start = chrono::steady_clock::now();
+    server.search(queries);
+    auto elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << label << ": entry " << sizeof(typename Index::entry_type) << " B, index RSS "
+         << toMiB(rss_index - rss_start) << " MiB, " << queries.size() << " queries in " << elapsed << " ms" << endl;
+}
+
+void benchIndexVariants(const vector<string>& corpus, const vector<string>& queries) {
+    cout << "=== Index variants ===" << endl;
+
+    size_t max_doc_length = 0;
+    for (const auto& doc : corpus) max_doc_length = max(max_doc_length, doc.size());
+    cout << "selected: " << IndexVariantName(SelectIndexVariant(corpus.size(), max_doc_length)) << endl;
+
+    if (SelectIndexVariant(corpus.size(), max_doc_length) == IndexVariant::Compact16) {
+        benchVariant<InvertedIndex16>("16-bit", corpus, queries);
+    }
+    benchVariant<InvertedIndex32>("32-bit", corpus, queries);
+    benchVariant<InvertedIndex64>("64-bit", corpus, queries);
+}
+
+vector<string> makeQueryLog(size_t count, const vector<string>& vocabulary, mt19937& rng) {
+    // Popular queries repeat with shuffled and duplicated terms, and many of them
+    // share a two-term rarest-first prefix (a "topic") extended by a common term.
+    uniform_int_distribution<size_t> head(0, 30);
+    uniform_int_distribution<size_t> mid(50, 500);
+    vector<pair<string, string>> topics(40);
+    for (auto& topic : topics) {
+        topic = {vocabulary[mid(rng)], vocabulary[mid(rng)]};
+    }
+    uniform_int_distribution<size_t> pick_topic(0, topics.size() - 1);
+    vector<vector<string>> pool(300);
+    for (auto& terms : pool) {
+        const auto& topic = topics[pick_topic(rng)];
+        terms = {topic.first, topic.second, vocabulary[head(rng)]};
+    }
+
+    vector<double> weights(pool.size());
+    for (size_t i = 0; i < weights.size(); ++i) weights[i] = 1.0 / static_cast<double>(i + 1);
+    discrete_distribution<size_t> pick(weights.begin(), weights.end());
+    bernoulli_distribution duplicate(0.2);
+
+    vector<string> log(count);
+    for (auto& query : log) {
+        auto terms = pool[pick(rng)];
+        shuffle(terms.begin(), terms.end(), rng);
+        if (duplicate(rng)) terms.push_back(terms.front());
+        for (const auto& term : terms) {
+            if (!query.empty()) query.push_back(' ');
+            query += term;
+        }
+    }
+    return log;
+}
+
+vector<string> readQueryLog(const string& path) {
+    ifstream file(path);
+    vector<string> log;
+    string line;
+    while (getline(file, line)) {
+        if (!line.empty()) log.push_back(line);
+    }
+    return log;
+}
+
+void benchQueryCache(const vector<string>& corpus, const vector<string>& log) {
+    cout << "=== Query cache ===" << endl;
+
+    InvertedIndex index;
+    index.UpdateDocumentBase(corpus);
+
+    for (bool cached : {false, true}) {
+        SearchServer server(index);
+        if (!cached) server.SetCacheLimits(0, 0);
+
+        auto start = chrono::steady_clock::now();
+        server.search(log);
+        auto elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        auto stats = server.GetCacheStats();
+        size_t result_lookups = stats.result_hits + stats.result_misses;
+        size_t intersection_lookups = stats.intersection_hits + stats.intersection_misses;
+        cout << (cached ? "cached" : "uncached") << ": " << log.size() << " queries in " << elapsed << " ms";
+        if (cached) {
+            cout << ", result hits " << 100.0 * static_cast<double>(stats.result_hits) / static_cast<double>(max<size_t>(result_lookups, 1))
+                 << "% (" << toMiB(stats.result_bytes) << " MiB), prefix hits on 3+ term misses "
+                 << 100.0 * static_cast<double>(stats.intersection_hits) / static_cast<double>(max<size_t>(intersection_lookups, 1))
+                 << "% (" << toMiB(stats.intersection_bytes) << " MiB)";
+        }
+        cout << endl;
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t doc_count = argc > 1 ? stoul(argv[1]) : 20000;
+    size_t words_per_doc = argc > 2 ? stoul(argv[2]) : 200;
+
+    mt19937 rng(42);
+    auto vocabulary = makeVocabulary(20000, rng);
+    auto corpus = makeCorpus(doc_count, words_per_doc, vocabulary, rng);
+
+    auto queries = makeQueries(1000, vocabulary, rng);
+    auto query_log = argc > 3 ? readQueryLog(argv[3]) : makeQueryLog(5000, vocabulary, rng);
+
+    benchDocumentStore(corpus);
+    benchQueryBudget(corpus, queries);
+    benchIndexVariants(corpus, queries);
+    benchQueryCache(corpus, query_log);
+
+    return 0;
+}
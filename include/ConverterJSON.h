@@ -21,7 +21,10 @@ public:
 
     std::vector<std::string> GetTextDocuments();
     int GetResponsesLimit();
+    std::string GetDocumentStorePath();
+    std::map<std::string, int> GetSearchLimits();
     std::vector<std::string> GetRequests();
-    void putAnswers(std::vector<std::vector<std::pair<int, float>>> answers);
+    void putAnswers(std::vector<std::vector<std::pair<int, float>>> answers,
+                    const std::vector<bool>& partial = {});
     std::map<std::string, std::string> GetConfigInfo();
 };
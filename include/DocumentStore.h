@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+
+// Read-only on-disk storage of raw document texts. Documents are packed into
+// compressed blocks; an offset table maps doc_id to its block and position.
+// The file is memory-mapped, so only the blocks actually requested are paged in.
+class DocumentStore {
+public:
+    explicit DocumentStore(const std::string& path);
+    ~DocumentStore();
+
+    DocumentStore(const DocumentStore&) = delete;
+    DocumentStore& operator=(const DocumentStore&) = delete;
+
+    static void Build(const std::string& path,
+                      const std::vector<std::string>& docs,
+                      size_t block_size = 64 * 1024);
+
+    size_t size() const;
+    std::string GetDocument(size_t doc_id) const;
+
+private:
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint64_t doc_count;
+        uint64_t block_count;
+    };
+
+    struct BlockInfo {
+        uint64_t offset;
+        uint32_t compressed_size;
+        uint32_t raw_size;
+    };
+
+    struct DocInfo {
+        uint32_t block;
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    const char* data = nullptr;
+    size_t data_size = 0;
+    const Header* header = nullptr;
+    const BlockInfo* blocks = nullptr;
+    const DocInfo* doc_infos = nullptr;
+
+    mutable std::mutex block_mutex;
+    mutable size_t cached_block = SIZE_MAX;
+    mutable std::string cached_text;
+
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#endif
+
+    void unmap();
+};
@@ -3,25 +3,46 @@
 #include <vector>
 #include <map>
 #include <mutex>
+#include <atomic>
+#include <cstdint>
 
-struct Entry {
-    size_t doc_id;
-    size_t count;
+template <typename DocId, typename Count>
+struct BasicEntry {
+    DocId doc_id;
+    Count count;
 
-    bool operator ==(const Entry& other) const {
+    bool operator ==(const BasicEntry& other) const {
         return (doc_id == other.doc_id && count == other.count);
     }
 };
 
-class InvertedIndex {
+// Postings are kept sorted by doc_id. Member definitions live in InvertedIndex.cpp
+// and are instantiated there for the InvertedIndex16/32/64 variants below.
+template <typename DocId, typename Count, template <typename...> class PostingContainer = std::vector>
+class BasicInvertedIndex {
 public:
-    InvertedIndex() = default;
+    using doc_id_type = DocId;
+    using count_type = Count;
+    using entry_type = BasicEntry<DocId, Count>;
+    using posting_list = PostingContainer<entry_type>;
+
+    BasicInvertedIndex() = default;
 
     void UpdateDocumentBase(std::vector<std::string> input_docs);
-    std::vector<Entry> GetWordCount(const std::string& word);
+    posting_list GetWordCount(const std::string& word);
+    // Reads postings in place; the reference stays valid until the next UpdateDocumentBase.
+    const posting_list& FindPostings(const std::string& word);
+    uint64_t Generation() const { return generation; }
 
 private:
-    std::vector<std::string> docs;
-    std::map<std::string, std::vector<Entry>> freq_dictionary;
+    std::map<std::string, posting_list> freq_dictionary;
     std::mutex dictionary_mutex;
-};
\ No newline at end of file
+    std::atomic<uint64_t> generation{0};
+};
+
+using InvertedIndex16 = BasicInvertedIndex<uint16_t, uint16_t>;
+using InvertedIndex32 = BasicInvertedIndex<uint32_t, uint32_t>;
+using InvertedIndex64 = BasicInvertedIndex<uint64_t, uint64_t>;
+
+using Entry = InvertedIndex64::entry_type;
+using InvertedIndex = InvertedIndex64;
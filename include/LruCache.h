@@ -0,0 +1,76 @@
+#pragma once
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+// Least-recently-used map bounded by an approximate byte budget supplied by the
+// caller on insertion. A zero budget disables the cache. Not thread-safe.
+template <typename Value>
+class LruCache {
+public:
+    explicit LruCache(size_t max_bytes = 0) : max_bytes(max_bytes) { };
+
+    bool Get(const std::string& key, Value& out) {
+        auto it = index.find(key);
+        if (it == index.end()) {
+            return false;
+        }
+        entries.splice(entries.begin(), entries, it->second);
+        out = it->second->value;
+        return true;
+    }
+
+    void Put(const std::string& key, Value value, size_t value_bytes) {
+        size_t bytes = key.size() + value_bytes + entry_overhead;
+        if (bytes > max_bytes) return;
+
+        auto it = index.find(key);
+        if (it != index.end()) {
+            used_bytes -= it->second->bytes;
+            entries.erase(it->second);
+            index.erase(it);
+        }
+
+        entries.push_front({key, std::move(value), bytes});
+        index[key] = entries.begin();
+        used_bytes += bytes;
+        evict();
+    }
+
+    void Clear() {
+        entries.clear();
+        index.clear();
+        used_bytes = 0;
+    }
+
+    void SetCapacity(size_t bytes) {
+        max_bytes = bytes;
+        evict();
+    }
+
+    size_t Bytes() const { return used_bytes; }
+    size_t Size() const { return entries.size(); }
+
+private:
+    struct Node {
+        std::string key;
+        Value value;
+        size_t bytes;
+    };
+
+    static constexpr size_t entry_overhead = 96;
+
+    std::list<Node> entries;
+    std::unordered_map<std::string, typename std::list<Node>::iterator> index;
+    size_t max_bytes;
+    size_t used_bytes = 0;
+
+    void evict() {
+        while (used_bytes > max_bytes && !entries.empty()) {
+            used_bytes -= entries.back().bytes;
+            index.erase(entries.back().key);
+            entries.pop_back();
+        }
+    }
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include "InvertedIndex.h"
+#include "SearchServer.h"
+
+enum class IndexVariant {
+    Compact16,
+    Compact32,
+    Wide64
+};
+
+IndexVariant SelectIndexVariant(size_t doc_count, size_t max_doc_length);
+const char* IndexVariantName(IndexVariant variant);
+
+// Runtime entry point over the compile-time index variants: picks the narrowest
+// doc-id and count width that fits the corpus and forwards searches to it.
+class SearchEngine {
+public:
+    explicit SearchEngine(std::vector<std::string> docs);
+    ~SearchEngine();
+
+    IndexVariant Variant() const { return variant; }
+
+    std::vector<std::vector<RelativeIndex>> search(const std::vector<std::string>& queries_input,
+                                                   const SearchBudget& budget = {});
+    const SearchStats& GetLastStats() const;
+    CacheStats GetCacheStats();
+
+private:
+    struct Backend;
+    template <typename Index> struct Engine;
+
+    IndexVariant variant;
+    std::unique_ptr<Backend> backend;
+};
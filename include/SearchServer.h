@@ -3,9 +3,11 @@
 #include <vector>
 #include <map>
 #include <cmath>
+#include <chrono>
 #include <unordered_map>
 #include <mutex>
 #include "InvertedIndex.h"
+#include "LruCache.h"
 
 struct RelativeIndex {
     size_t doc_id;
@@ -18,18 +20,83 @@ struct RelativeIndex {
     }
 };
 
-class SearchServer {
+// Zero means "no limit". Work is counted in postings and candidates visited.
+// A query that runs out returns the candidates verified so far, which are the
+// lowest doc ids rather than the best-ranked ones; ranks are relative to them.
+struct SearchBudget {
+    std::chrono::milliseconds query_timeout{0};
+    size_t query_work_limit = 0;
+    std::chrono::milliseconds batch_timeout{0};
+};
+
+struct SearchStats {
+    std::vector<bool> partial;
+    std::vector<double> latency_ms;
+    size_t budget_exceeded = 0;
+
+    double LatencyPercentile(double p) const;
+};
+
+// Hits and misses are counted once per query for each layer; the intersection
+// layer is only consulted by queries of three or more distinct terms.
+struct CacheStats {
+    size_t result_hits = 0;
+    size_t result_misses = 0;
+    size_t intersection_hits = 0;
+    size_t intersection_misses = 0;
+    size_t result_bytes = 0;
+    size_t intersection_bytes = 0;
+};
+
+class QueryDeadline {
 public:
-    SearchServer(InvertedIndex& idx) : _index(idx) { };
+    using clock = std::chrono::steady_clock;
+
+    QueryDeadline(clock::time_point deadline, size_t work_limit)
+        : deadline(deadline), work_limit(work_limit) { };
 
-    std::vector<std::vector<RelativeIndex>> search(const std::vector<std::string>& queries_input);
+    bool Charge(size_t work = 1);
+    bool Expired() const { return expired; }
 
 private:
-    InvertedIndex& _index;
-    std::unordered_map<std::string, std::vector<RelativeIndex>> cache;
+    static constexpr size_t clock_check_interval = 256;
+
+    clock::time_point deadline;
+    size_t work_limit;
+    size_t work_done = 0;
+    size_t next_clock_check = 0;
+    bool expired = false;
+};
+
+// Member definitions live in SearchServer.cpp and are instantiated there for
+// InvertedIndex16/32/64, so ranking loops are compiled for each doc-id width.
+template <typename Index>
+class BasicSearchServer {
+public:
+    using doc_id_type = typename Index::doc_id_type;
+
+    BasicSearchServer(Index& idx) : _index(idx) { };
+
+    std::vector<std::vector<RelativeIndex>> search(const std::vector<std::string>& queries_input,
+                                                   const SearchBudget& budget = {});
+    const SearchStats& GetLastStats() const { return last_stats; }
+
+    void SetCacheLimits(size_t result_bytes, size_t intersection_bytes);
+    CacheStats GetCacheStats();
+
+private:
+    Index& _index;
+    // Both caches are keyed on sorted, deduplicated lowercase terms. The second
+    // one holds doc-id lists for strict rarest-first prefixes of at least two terms.
+    LruCache<std::vector<RelativeIndex>> result_cache{8 * 1024 * 1024};
+    LruCache<std::vector<doc_id_type>> intersection_cache{8 * 1024 * 1024};
+    uint64_t cache_generation = 0;
+    CacheStats cache_stats;
     std::mutex cache_mutex;
-    size_t max_cache_size = 1000;
+    SearchStats last_stats;
+
+    std::vector<RelativeIndex> processSingleQuery(const std::string& query, QueryDeadline& deadline, bool& partial);
+    void invalidateStaleCache();
+};
 
-    std::vector<RelativeIndex> processSingleQuery(const std::string& query);
-    void cleanupCache();
-};
\ No newline at end of file
+using SearchServer = BasicSearchServer<InvertedIndex>;
@@ -37,6 +37,20 @@ void ConverterJSON::validateConfig(const json& config) const {
         }
     }
 
+    for (const char* key : {"query_timeout_ms", "query_work_limit", "batch_timeout_ms"}) {
+        if (config_section.contains(key)) {
+            if (!config_section[key].is_number_integer() || config_section[key].get<int>() < 0) {
+                throw runtime_error(string(key) + " must be a non-negative integer");
+            }
+        }
+    }
+
+    if (config_section.contains("document_store")) {
+        if (!config_section["document_store"].is_string()) {
+            throw runtime_error("document_store must be a string");
+        }
+    }
+
     if (config.contains("files")) {
         if (!config["files"].is_array()) {
             throw runtime_error("files must be an array");
@@ -135,6 +149,41 @@ int ConverterJSON::GetResponsesLimit() {
     return 5;
 }
 
+string ConverterJSON::GetDocumentStorePath() {
+    if (!fileExists(config_path)) {
+        throw runtime_error("config file is missing");
+    }
+
+    ifstream config_file(config_path);
+    json config_data = json::parse(config_file);
+    validateConfig(config_data);
+
+    const auto& config_section = config_data["config"];
+    if (config_section.contains("document_store")) {
+        return config_section["document_store"];
+    }
+
+    return "";
+}
+
+map<string, int> ConverterJSON::GetSearchLimits() {
+    if (!fileExists(config_path)) {
+        throw runtime_error("config file is missing");
+    }
+
+    ifstream config_file(config_path);
+    json config_data = json::parse(config_file);
+    validateConfig(config_data);
+
+    map<string, int> limits;
+    const auto& config_section = config_data["config"];
+    for (const char* key : {"query_timeout_ms", "query_work_limit", "batch_timeout_ms"}) {
+        limits[key] = config_section.contains(key) ? config_section[key].get<int>() : 0;
+    }
+
+    return limits;
+}
+
 vector<string> ConverterJSON::GetRequests() {
     if (!fileExists(requests_path)) {
         throw runtime_error("requests.json file is missing");
@@ -162,7 +211,7 @@ vector<string> ConverterJSON::GetRequests() {
     return requests;
 }
 
-void ConverterJSON::putAnswers(vector<vector<pair<int, float>>> answers) {
+void ConverterJSON::putAnswers(vector<vector<pair<int, float>>> answers, const vector<bool>& partial) {
     json answers_json;
     answers_json["answers"] = json::object();
 
@@ -197,6 +246,10 @@ void ConverterJSON::putAnswers(vector<vector<pair<int, float>>> answers) {
                 {"relevance", relevance_array}
             };
         }
+
+        if (i < partial.size() && partial[i]) {
+            answers_json["answers"][request_id]["partial"] = "true";
+        }
     }
 
     ofstream answers_file(answers_path);
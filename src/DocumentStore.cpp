@@ -0,0 +1,307 @@
+#include "DocumentStore.h"
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+const char store_magic[4] = {'S', 'E', 'D', 'S'};
+const uint32_t store_version = 1;
+
+const size_t hash_bits = 12;
+const size_t min_match = 4;
+const size_t max_offset = 65535;
+
+void putVarint(string& out, size_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+size_t getVarint(const char*& src, const char* end) {
+    size_t value = 0;
+    int shift = 0;
+    while (src < end && shift < 64) {
+        auto byte = static_cast<unsigned char>(*src++);
+        value |= static_cast<size_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return value;
+        shift += 7;
+    }
+    throw runtime_error("document store is corrupted");
+}
+
+uint32_t hash4(const char* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return (v * 2654435761u) >> (32 - hash_bits);
+}
+
+// Byte-oriented LZ77: each sequence is <literal count, literals, match length,
+// match offset>, the final sequence carries a zero match length.
+string compressBlock(const string& src) {
+    string out;
+    out.reserve(src.size() / 2 + 16);
+
+    vector<size_t> table(size_t(1) << hash_bits, SIZE_MAX);
+    size_t anchor = 0;
+    size_t i = 0;
+
+    while (i + min_match <= src.size()) {
+        uint32_t h = hash4(&src[i]);
+        size_t candidate = table[h];
+        table[h] = i;
+
+        if (candidate == SIZE_MAX || i - candidate > max_offset ||
+            memcmp(&src[candidate], &src[i], min_match) != 0) {
+            ++i;
+            continue;
+        }
+
+        size_t length = min_match;
+        while (i + length < src.size() && src[candidate + length] == src[i + length]) {
+            ++length;
+        }
+
+        putVarint(out, i - anchor);
+        out.append(src, anchor, i - anchor);
+        putVarint(out, length);
+        putVarint(out, i - candidate);
+
+        i += length;
+        anchor = i;
+    }
+
+    putVarint(out, src.size() - anchor);
+    out.append(src, anchor, string::npos);
+    putVarint(out, 0);
+    return out;
+}
+
+string decompressBlock(const char* src, size_t size, size_t raw_size) {
+    const char* end = src + size;
+    string out;
+    out.reserve(raw_size);
+
+    while (true) {
+        size_t literals = getVarint(src, end);
+        if (literals > static_cast<size_t>(end - src) || out.size() + literals > raw_size) {
+            throw runtime_error("document store is corrupted");
+        }
+        out.append(src, literals);
+        src += literals;
+
+        size_t length = getVarint(src, end);
+        if (length == 0) break;
+
+        size_t offset = getVarint(src, end);
+        if (offset == 0 || offset > out.size() || out.size() + length > raw_size) {
+            throw runtime_error("document store is corrupted");
+        }
+        size_t from = out.size() - offset;
+        for (size_t k = 0; k < length; ++k) {
+            out.push_back(out[from + k]);
+        }
+    }
+
+    if (out.size() != raw_size) {
+        throw runtime_error("document store is corrupted");
+    }
+    return out;
+}
+
+}
+
+void DocumentStore::Build(const string& path, const vector<string>& docs, size_t block_size) {
+    vector<BlockInfo> block_infos;
+    vector<DocInfo> doc_table;
+    vector<string> compressed;
+    doc_table.reserve(docs.size());
+
+    size_t data_offset = sizeof(Header);
+    string block;
+
+    auto flush = [&]() {
+        if (block.empty()) return;
+        compressed.push_back(compressBlock(block));
+        block_infos.push_back({0, static_cast<uint32_t>(compressed.back().size()),
+                               static_cast<uint32_t>(block.size())});
+        block.clear();
+    };
+
+    for (const auto& doc : docs) {
+        if (doc.size() > UINT32_MAX) {
+            throw runtime_error("document is too large for the document store");
+        }
+        if (!doc.empty() && !block.empty() && block.size() + doc.size() > block_size) {
+            flush();
+        }
+        doc_table.push_back({static_cast<uint32_t>(block_infos.size()),
+                             static_cast<uint32_t>(block.size()),
+                             static_cast<uint32_t>(doc.size())});
+        block += doc;
+    }
+    flush();
+
+    data_offset += block_infos.size() * sizeof(BlockInfo) + doc_table.size() * sizeof(DocInfo);
+    for (size_t i = 0; i < block_infos.size(); ++i) {
+        block_infos[i].offset = data_offset;
+        data_offset += compressed[i].size();
+    }
+
+    Header header{};
+    memcpy(header.magic, store_magic, sizeof(store_magic));
+    header.version = store_version;
+    header.doc_count = doc_table.size();
+    header.block_count = block_infos.size();
+
+    ofstream file(path, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        throw runtime_error("cannot create document store: " + path);
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(block_infos.data()), block_infos.size() * sizeof(BlockInfo));
+    file.write(reinterpret_cast<const char*>(doc_table.data()), doc_table.size() * sizeof(DocInfo));
+    for (const auto& data : compressed) {
+        file.write(data.data(), data.size());
+    }
+    if (!file.good()) {
+        throw runtime_error("cannot write document store: " + path);
+    }
+}
+
+DocumentStore::DocumentStore(const string& path) {
+#ifdef _WIN32
+    file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        file_handle = nullptr;
+        throw runtime_error("document store is missing: " + path);
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle, &file_size)) {
+        unmap();
+        throw runtime_error("cannot read document store: " + path);
+    }
+    data_size = static_cast<size_t>(file_size.QuadPart);
+    if (data_size > 0) {
+        mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_handle) {
+            data = static_cast<const char*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+        }
+        if (!data) {
+            unmap();
+            throw runtime_error("cannot map document store: " + path);
+        }
+    }
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("document store is missing: " + path);
+    }
+    struct stat st {};
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw runtime_error("cannot read document store: " + path);
+    }
+    data_size = static_cast<size_t>(st.st_size);
+    if (data_size > 0) {
+        void* mapped = mmap(nullptr, data_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            throw runtime_error("cannot map document store: " + path);
+        }
+        data = static_cast<const char*>(mapped);
+    }
+    close(fd);
+#endif
+
+    if (data_size < sizeof(Header)) {
+        unmap();
+        throw runtime_error("document store is corrupted: " + path);
+    }
+
+    header = reinterpret_cast<const Header*>(data);
+    if (memcmp(header->magic, store_magic, sizeof(store_magic)) != 0 ||
+        header->version != store_version) {
+        unmap();
+        throw runtime_error("document store has incorrect file version: " + path);
+    }
+
+    size_t remaining = data_size - sizeof(Header);
+    bool tables_fit = header->block_count <= remaining / sizeof(BlockInfo);
+    if (tables_fit) {
+        remaining -= static_cast<size_t>(header->block_count) * sizeof(BlockInfo);
+        tables_fit = header->doc_count <= remaining / sizeof(DocInfo);
+    }
+    if (!tables_fit) {
+        unmap();
+        throw runtime_error("document store is corrupted: " + path);
+    }
+
+    blocks = reinterpret_cast<const BlockInfo*>(data + sizeof(Header));
+    doc_infos = reinterpret_cast<const DocInfo*>(blocks + header->block_count);
+}
+
+DocumentStore::~DocumentStore() {
+    unmap();
+}
+
+void DocumentStore::unmap() {
+#ifdef _WIN32
+    if (data) UnmapViewOfFile(data);
+    if (mapping_handle) CloseHandle(mapping_handle);
+    if (file_handle) CloseHandle(file_handle);
+    mapping_handle = nullptr;
+    file_handle = nullptr;
+#else
+    if (data) munmap(const_cast<char*>(data), data_size);
+#endif
+    data = nullptr;
+    data_size = 0;
+    header = nullptr;
+    blocks = nullptr;
+    doc_infos = nullptr;
+}
+
+size_t DocumentStore::size() const {
+    return header ? header->doc_count : 0;
+}
+
+string DocumentStore::GetDocument(size_t doc_id) const {
+    if (doc_id >= size()) {
+        throw out_of_range("document id is out of range");
+    }
+
+    const DocInfo& doc = doc_infos[doc_id];
+    if (doc.length == 0) {
+        return "";
+    }
+    if (doc.block >= header->block_count) {
+        throw runtime_error("document store is corrupted");
+    }
+
+    const BlockInfo& block = blocks[doc.block];
+    if (block.offset > data_size || block.compressed_size > data_size - block.offset ||
+        static_cast<size_t>(doc.offset) + doc.length > block.raw_size) {
+        throw runtime_error("document store is corrupted");
+    }
+
+    lock_guard<mutex> lock(block_mutex);
+    if (cached_block != doc.block) {
+        cached_text = decompressBlock(data + block.offset, block.compressed_size, block.raw_size);
+        cached_block = doc.block;
+    }
+    return cached_text.substr(doc.offset, doc.length);
+}
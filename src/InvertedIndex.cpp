@@ -3,20 +3,30 @@
 #include <algorithm>
 #include <thread>
 #include <unordered_map>
+#include <limits>
+#include <atomic>
+#include <stdexcept>
 
 using namespace std;
 
-void InvertedIndex::UpdateDocumentBase(vector<string> input_docs) {
-    docs = move(input_docs);
+template <typename DocId, typename Count, template <typename...> class PostingContainer>
+void BasicInvertedIndex<DocId, Count, PostingContainer>::UpdateDocumentBase(vector<string> input_docs) {
     freq_dictionary.clear();
+    generation++;
+    if (input_docs.empty()) return;
 
-    const size_t num_threads = std::min<size_t>(thread::hardware_concurrency(), docs.size());
+    if (input_docs.size() - 1 > numeric_limits<DocId>::max()) {
+        throw runtime_error("too many documents for this index variant");
+    }
+
+    const size_t num_threads = std::max<size_t>(1, std::min<size_t>(thread::hardware_concurrency(), input_docs.size()));
     vector<thread> threads;
-    vector<map<string, vector<Entry>>> thread_results(num_threads);
+    atomic<bool> count_overflow{false};
+    vector<map<string, posting_list>> thread_results(num_threads);
 
     auto process_docs = [&](size_t start, size_t end, size_t thread_id) {
         for (size_t doc_id = start; doc_id < end; ++doc_id) {
-            stringstream ss(docs[doc_id]);
+            stringstream ss(input_docs[doc_id]);
             string word;
             unordered_map<string, size_t> word_count;
 
@@ -27,16 +37,20 @@ void InvertedIndex::UpdateDocumentBase(vector<string> input_docs) {
             }
 
             for (const auto& [word, count] : word_count) {
-                thread_results[thread_id][word].push_back({doc_id, count});
+                if (count > numeric_limits<Count>::max()) {
+                    count_overflow = true;
+                    return;
+                }
+                thread_results[thread_id][word].push_back({static_cast<DocId>(doc_id), static_cast<Count>(count)});
             }
         }
     };
 
-    size_t docs_per_thread = (docs.size() + num_threads - 1) / num_threads;
+    size_t docs_per_thread = (input_docs.size() + num_threads - 1) / num_threads;
     for (size_t i = 0; i < num_threads; ++i) {
         size_t start = i * docs_per_thread;
-        size_t end = min(start + docs_per_thread, docs.size());
-        if (start < docs.size()) {
+        size_t end = min(start + docs_per_thread, input_docs.size());
+        if (start < input_docs.size()) {
             threads.emplace_back(process_docs, start, end, i);
         }
     }
@@ -45,6 +59,13 @@ void InvertedIndex::UpdateDocumentBase(vector<string> input_docs) {
         thread.join();
     }
 
+    input_docs.clear();
+    input_docs.shrink_to_fit();
+
+    if (count_overflow) {
+        throw runtime_error("word count overflows this index variant");
+    }
+
     lock_guard<mutex> lock(dictionary_mutex);
     for (const auto& thread_result : thread_results) {
         for (const auto& [word, entries] : thread_result) {
@@ -55,9 +76,12 @@ void InvertedIndex::UpdateDocumentBase(vector<string> input_docs) {
             );
         }
     }
+    generation++;
 }
 
-vector<Entry> InvertedIndex::GetWordCount(const string& word) {
+template <typename DocId, typename Count, template <typename...> class PostingContainer>
+typename BasicInvertedIndex<DocId, Count, PostingContainer>::posting_list
+BasicInvertedIndex<DocId, Count, PostingContainer>::GetWordCount(const string& word) {
     string word_lower = word;
     transform(word_lower.begin(), word_lower.end(), word_lower.begin(), ::tolower);
 
@@ -68,4 +92,21 @@ vector<Entry> InvertedIndex::GetWordCount(const string& word) {
     }
     
     return {};
-}
\ No newline at end of file
+}
+
+template <typename DocId, typename Count, template <typename...> class PostingContainer>
+const typename BasicInvertedIndex<DocId, Count, PostingContainer>::posting_list&
+BasicInvertedIndex<DocId, Count, PostingContainer>::FindPostings(const string& word) {
+    static const posting_list empty;
+
+    string word_lower = word;
+    transform(word_lower.begin(), word_lower.end(), word_lower.begin(), ::tolower);
+
+    lock_guard<mutex> lock(dictionary_mutex);
+    auto it = freq_dictionary.find(word_lower);
+    return it != freq_dictionary.end() ? it->second : empty;
+}
+
+template class BasicInvertedIndex<uint16_t, uint16_t>;
+template class BasicInvertedIndex<uint32_t, uint32_t>;
+template class BasicInvertedIndex<uint64_t, uint64_t>;
@@ -0,0 +1,96 @@
+#include "SearchEngine.h"
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+struct SearchEngine::Backend {
+    virtual ~Backend() = default;
+    virtual vector<vector<RelativeIndex>> search(const vector<string>& queries, const SearchBudget& budget) = 0;
+    virtual const SearchStats& GetLastStats() const = 0;
+    virtual CacheStats GetCacheStats() = 0;
+};
+
+template <typename Index>
+struct SearchEngine::Engine : SearchEngine::Backend {
+    Index index;
+    BasicSearchServer<Index> server{index};
+
+    explicit Engine(vector<string> docs) {
+        index.UpdateDocumentBase(move(docs));
+    }
+
+    vector<vector<RelativeIndex>> search(const vector<string>& queries, const SearchBudget& budget) override {
+        return server.search(queries, budget);
+    }
+
+    const SearchStats& GetLastStats() const override {
+        return server.GetLastStats();
+    }
+
+    CacheStats GetCacheStats() override {
+        return server.GetCacheStats();
+    }
+};
+
+namespace {
+
+// A document of n bytes holds at most (n + 1) / 2 words, which bounds any count.
+template <typename Index>
+bool fits(size_t doc_count, size_t max_doc_length) {
+    using doc_id_type = typename Index::doc_id_type;
+    using count_type = typename Index::count_type;
+    return (doc_count == 0 || doc_count - 1 <= numeric_limits<doc_id_type>::max()) &&
+           max_doc_length / 2 < numeric_limits<count_type>::max();
+}
+
+}
+
+IndexVariant SelectIndexVariant(size_t doc_count, size_t max_doc_length) {
+    if (fits<InvertedIndex16>(doc_count, max_doc_length)) return IndexVariant::Compact16;
+    if (fits<InvertedIndex32>(doc_count, max_doc_length)) return IndexVariant::Compact32;
+    return IndexVariant::Wide64;
+}
+
+const char* IndexVariantName(IndexVariant variant) {
+    switch (variant) {
+        case IndexVariant::Compact16: return "16-bit";
+        case IndexVariant::Compact32: return "32-bit";
+        case IndexVariant::Wide64: return "64-bit";
+    }
+    return "unknown";
+}
+
+SearchEngine::SearchEngine(vector<string> docs) {
+    size_t max_doc_length = 0;
+    for (const auto& doc : docs) {
+        max_doc_length = max(max_doc_length, doc.size());
+    }
+
+    variant = SelectIndexVariant(docs.size(), max_doc_length);
+    switch (variant) {
+        case IndexVariant::Compact16:
+            backend = make_unique<Engine<InvertedIndex16>>(move(docs));
+            break;
+        case IndexVariant::Compact32:
+            backend = make_unique<Engine<InvertedIndex32>>(move(docs));
+            break;
+        case IndexVariant::Wide64:
+            backend = make_unique<Engine<InvertedIndex64>>(move(docs));
+            break;
+    }
+}
+
+SearchEngine::~SearchEngine() = default;
+
+vector<vector<RelativeIndex>> SearchEngine::search(const vector<string>& queries_input, const SearchBudget& budget) {
+    return backend->search(queries_input, budget);
+}
+
+const SearchStats& SearchEngine::GetLastStats() const {
+    return backend->GetLastStats();
+}
+
+CacheStats SearchEngine::GetCacheStats() {
+    return backend->GetCacheStats();
+}
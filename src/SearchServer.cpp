@@ -2,90 +2,191 @@
 #include <algorithm>
 #include <sstream>
 #include <map>
-#include <set>
+#include <utility>
+#include <iterator>
 
 using namespace std;
 
-vector<RelativeIndex> SearchServer::processSingleQuery(const string& query) {
-    string query_lower = query;
-    transform(query_lower.begin(), query_lower.end(), query_lower.begin(), ::tolower);
+bool QueryDeadline::Charge(size_t work) {
+    if (expired) return true;
 
-    {
-        lock_guard<mutex> lock(cache_mutex);
-        auto it = cache.find(query_lower);
-        if (it != cache.end()) {
-            return it->second;
-        }
+    work_done += work;
+    if (work_limit > 0 && work_done > work_limit) {
+        expired = true;
+    } else if (deadline != clock::time_point::max() && work_done >= next_clock_check) {
+        next_clock_check = work_done + clock_check_interval;
+        expired = clock::now() >= deadline;
     }
+    return expired;
+}
 
-    if (query.empty()) {
-        return {};
+double SearchStats::LatencyPercentile(double p) const {
+    if (latency_ms.empty()) return 0.0;
+
+    vector<double> sorted = latency_ms;
+    sort(sorted.begin(), sorted.end());
+    size_t rank = static_cast<size_t>(ceil(p / 100.0 * static_cast<double>(sorted.size())));
+    return sorted[min(max<size_t>(rank, 1), sorted.size()) - 1];
+}
+
+namespace {
+
+template <typename Iterator>
+string joinTerms(Iterator first, Iterator last) {
+    string key;
+    for (auto it = first; it != last; ++it) {
+        if (!key.empty()) key.push_back(' ');
+        key += *it;
     }
+    return key;
+}
+
+string prefixKey(const vector<string>& words, size_t length) {
+    vector<string> prefix(words.begin(), words.begin() + length);
+    sort(prefix.begin(), prefix.end());
+    return joinTerms(prefix.begin(), prefix.end());
+}
+
+}
+
+template <typename Index>
+vector<RelativeIndex> BasicSearchServer<Index>::processSingleQuery(const string& query, QueryDeadline& deadline, bool& partial) {
+    partial = false;
 
     stringstream ss(query);
     string word;
     vector<string> words;
-    map<string, size_t> word_frequency;
 
     while (ss >> word) {
         transform(word.begin(), word.end(), word.begin(), ::tolower);
-        if (find(words.begin(), words.end(), word) == words.end()) {
-            words.push_back(word);
-            auto entries = _index.GetWordCount(word);
-            word_frequency[word] = entries.size();
-        }
+        words.push_back(word);
     }
 
     if (words.empty()) {
         return {};
     }
 
-    sort(words.begin(), words.end(), [&](const string& a, const string& b) {
-        return word_frequency[a] < word_frequency[b];
+    sort(words.begin(), words.end());
+    words.erase(unique(words.begin(), words.end()), words.end());
+
+    string query_key = joinTerms(words.begin(), words.end());
+    {
+        lock_guard<mutex> lock(cache_mutex);
+        vector<RelativeIndex> cached;
+        if (result_cache.Get(query_key, cached)) {
+            cache_stats.result_hits++;
+            return cached;
+        }
+        cache_stats.result_misses++;
+    }
+
+    map<string, const typename Index::posting_list*> word_entries;
+    for (const auto& term : words) {
+        word_entries[term] = &_index.FindPostings(term);
+    }
+
+    stable_sort(words.begin(), words.end(), [&](const string& a, const string& b) {
+        return word_entries[a]->size() < word_entries[b]->size();
     });
 
-    set<size_t> relevant_docs;
-    for (const auto& word : words) {
-        auto entries = _index.GetWordCount(word);
-        set<size_t> current_docs;
-        for (const auto& entry : entries) {
-            current_docs.insert(entry.doc_id);
+    // Candidates are taken one at a time from the rarest term (or a cached prefix)
+    // and checked against every remaining term, so anything collected before the
+    // budget runs out matches the whole query.
+    vector<doc_id_type> base_docs;
+    size_t first_check = 1;
+    bool from_cache = false;
+    {
+        lock_guard<mutex> lock(cache_mutex);
+        for (size_t prefix = words.size() - 1; prefix >= 2; --prefix) {
+            if (intersection_cache.Get(prefixKey(words, prefix), base_docs)) {
+                first_check = prefix;
+                from_cache = true;
+                break;
+            }
+        }
+        if (from_cache) {
+            cache_stats.intersection_hits++;
+        } else if (words.size() >= 3) {
+            cache_stats.intersection_misses++;
+        }
+    }
+
+    const auto& rarest = *word_entries[words[0]];
+    size_t base_count = from_cache ? base_docs.size() : rarest.size();
+
+    vector<typename Index::posting_list::const_iterator> cursors;
+    for (const auto& term : words) {
+        cursors.push_back(word_entries[term]->begin());
+    }
+
+    vector<doc_id_type> relevant_docs;
+    vector<vector<doc_id_type>> prefix_docs(words.size());
+    for (size_t i = 0; i < base_count; ++i) {
+        if (deadline.Charge()) {
+            partial = true;
+            break;
+        }
+
+        doc_id_type doc_id = from_cache ? base_docs[i] : rarest[i].doc_id;
+        size_t matched = first_check;
+        for (; matched < words.size(); ++matched) {
+            if (deadline.Charge()) {
+                partial = true;
+                break;
+            }
+
+            const auto& entries = *word_entries[words[matched]];
+            auto& cursor = cursors[matched];
+            cursor = lower_bound(cursor, entries.end(), doc_id,
+                [](const typename Index::entry_type& entry, doc_id_type id) { return entry.doc_id < id; });
+            if (cursor == entries.end() || cursor->doc_id != doc_id) break;
+
+            if (matched + 1 < words.size()) {
+                prefix_docs[matched].push_back(doc_id);
+            }
         }
 
-        if (relevant_docs.empty()) {
-            relevant_docs = current_docs;
-        } else {
-            set<size_t> intersection;
-            set_intersection(
-                relevant_docs.begin(), relevant_docs.end(),
-                current_docs.begin(), current_docs.end(),
-                inserter(intersection, intersection.begin())
-            );
-            relevant_docs = intersection;
+        if (partial) break;
+        if (matched == words.size()) {
+            relevant_docs.push_back(doc_id);
         }
+    }
 
-        if (relevant_docs.empty()) break;
+    if (!partial) {
+        lock_guard<mutex> lock(cache_mutex);
+        for (size_t prefix = first_check; prefix + 1 < words.size(); ++prefix) {
+            intersection_cache.Put(prefixKey(words, prefix + 1), prefix_docs[prefix],
+                                   prefix_docs[prefix].size() * sizeof(doc_id_type));
+        }
     }
 
     if (relevant_docs.empty()) {
         return {};
     }
 
-    map<size_t, float> doc_relevance;
+    vector<pair<doc_id_type, float>> doc_relevance;
+    doc_relevance.reserve(relevant_docs.size());
     float max_relevance = 0.0f;
 
-    for (size_t doc_id : relevant_docs) {
+    // Candidates verified before an interrupted intersection were each charged, so
+    // they are scored in full; otherwise scoring itself is bounded.
+    bool bounded_scoring = !partial;
+    for (doc_id_type doc_id : relevant_docs) {
+        if (bounded_scoring && deadline.Charge(words.size())) {
+            partial = true;
+            break;
+        }
+
         float relevance = 0.0f;
         for (const auto& word : words) {
-            auto entries = _index.GetWordCount(word);
-            for (const auto& entry : entries) {
-                if (entry.doc_id == doc_id) {
-                    relevance += static_cast<float>(entry.count);
-                    break;
-                }
+            const auto& entries = *word_entries[word];
+            auto it = lower_bound(entries.begin(), entries.end(), doc_id,
+                [](const typename Index::entry_type& entry, doc_id_type id) { return entry.doc_id < id; });
+            if (it != entries.end() && it->doc_id == doc_id) {
+                relevance += static_cast<float>(it->count);
             }
         }
-        doc_relevance[doc_id] = relevance;
+        doc_relevance.emplace_back(doc_id, relevance);
         if (relevance > max_relevance) {
             max_relevance = relevance;
         }
@@ -94,7 +195,7 @@ vector<RelativeIndex> SearchServer::processSingleQuery(const string& query) {
     vector<RelativeIndex> query_result;
     for (const auto& [doc_id, relevance] : doc_relevance) {
         float relative_rank = (max_relevance > 0) ? relevance / max_relevance : 0.0f;
-        query_result.push_back({doc_id, relative_rank});
+        query_result.push_back({static_cast<size_t>(doc_id), relative_rank});
     }
 
     sort(query_result.begin(), query_result.end(),
@@ -105,29 +206,76 @@ vector<RelativeIndex> SearchServer::processSingleQuery(const string& query) {
             return a.rank > b.rank;
         });
 
-    lock_guard<mutex> lock(cache_mutex);
-    if (cache.size() >= max_cache_size) {
-        cleanupCache();
+    if (partial) {
+        return query_result;
     }
-    cache[query_lower] = query_result;
+
+    lock_guard<mutex> lock(cache_mutex);
+    result_cache.Put(query_key, query_result, query_result.size() * sizeof(RelativeIndex));
 
     return query_result;
 }
 
-void SearchServer::cleanupCache() {
-    if (cache.size() > max_cache_size / 2) {
-        auto it = cache.begin();
-        advance(it, cache.size() / 2);
-        cache.erase(cache.begin(), it);
+template <typename Index>
+void BasicSearchServer<Index>::invalidateStaleCache() {
+    lock_guard<mutex> lock(cache_mutex);
+    if (cache_generation != _index.Generation()) {
+        result_cache.Clear();
+        intersection_cache.Clear();
+        cache_generation = _index.Generation();
     }
 }
 
-vector<vector<RelativeIndex>> SearchServer::search(const vector<string>& queries_input) {
+template <typename Index>
+void BasicSearchServer<Index>::SetCacheLimits(size_t result_bytes, size_t intersection_bytes) {
+    lock_guard<mutex> lock(cache_mutex);
+    result_cache.SetCapacity(result_bytes);
+    intersection_cache.SetCapacity(intersection_bytes);
+}
+
+template <typename Index>
+CacheStats BasicSearchServer<Index>::GetCacheStats() {
+    lock_guard<mutex> lock(cache_mutex);
+    CacheStats stats = cache_stats;
+    stats.result_bytes = result_cache.Bytes();
+    stats.intersection_bytes = intersection_cache.Bytes();
+    return stats;
+}
+
+template <typename Index>
+vector<vector<RelativeIndex>> BasicSearchServer<Index>::search(const vector<string>& queries_input, const SearchBudget& budget) {
     vector<vector<RelativeIndex>> result;
+    last_stats = {};
+    invalidateStaleCache();
+
+    auto batch_start = QueryDeadline::clock::now();
+    auto batch_deadline = budget.batch_timeout.count() > 0
+        ? batch_start + budget.batch_timeout
+        : QueryDeadline::clock::time_point::max();
 
     for (const auto& query : queries_input) {
-        result.push_back(processSingleQuery(query));
+        auto query_start = QueryDeadline::clock::now();
+        auto query_deadline = budget.query_timeout.count() > 0
+            ? min(batch_deadline, query_start + budget.query_timeout)
+            : batch_deadline;
+
+        QueryDeadline deadline(query_deadline, budget.query_work_limit);
+        deadline.Charge(0);
+
+        bool partial = false;
+        result.push_back(processSingleQuery(query, deadline, partial));
+
+        chrono::duration<double, milli> latency = QueryDeadline::clock::now() - query_start;
+        last_stats.latency_ms.push_back(latency.count());
+        last_stats.partial.push_back(partial);
+        if (partial) {
+            last_stats.budget_exceeded++;
+        }
     }
     
     return result;
-}
\ No newline at end of file
+}
+
+template class BasicSearchServer<InvertedIndex16>;
+template class BasicSearchServer<InvertedIndex32>;
+template class BasicSearchServer<InvertedIndex64>;
@@ -5,12 +5,13 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <utility>
 #include <fstream>
 #include <chrono>
 #include <iomanip>
 #include "ConverterJSON.h"
-#include "InvertedIndex.h"
-#include "SearchServer.h"
+#include "SearchEngine.h"
+#include "DocumentStore.h"
 
 void setupConsole() {
 #ifdef _WIN32
@@ -61,23 +62,52 @@ int main(int argc, char **argv) {
         std::cout << "Loaded " << documents.size() << " documents" << std::endl;
         logger.log("Documents loaded: " + std::to_string(documents.size()));
 
+        std::string store_path = converter.GetDocumentStorePath();
+        if (!store_path.empty()) {
+            DocumentStore::Build(store_path, documents);
+            std::cout << "Document store written to " << store_path << std::endl;
+            logger.log("Document store written: " + store_path);
+        }
+
         auto requests = converter.GetRequests();
         std::cout << "Loaded " << requests.size() << " requests" << std::endl;
         logger.log("Requests loaded: " + std::to_string(requests.size()));
 
         std::cout << "=== SEARCH SERVER DEMO ===" << std::endl;
         logger.log("Starting search server");
-        InvertedIndex index;
-        index.UpdateDocumentBase(documents);
-        SearchServer server(index);
-
-        auto search_results = server.search(requests);
+        SearchEngine engine(std::move(documents));
+        std::cout << "Index variant: " << IndexVariantName(engine.Variant()) << std::endl;
+        logger.log(std::string("Index variant: ") + IndexVariantName(engine.Variant()));
+
+        auto limits = converter.GetSearchLimits();
+        SearchBudget budget;
+        budget.query_timeout = std::chrono::milliseconds(limits["query_timeout_ms"]);
+        budget.query_work_limit = static_cast<size_t>(limits["query_work_limit"]);
+        budget.batch_timeout = std::chrono::milliseconds(limits["batch_timeout_ms"]);
+
+        auto search_results = engine.search(requests, budget);
+        const auto& stats = engine.GetLastStats();
         std::cout << "Search results for " << requests.size() << " queries:" << std::endl;
         logger.log("Search completed for " + std::to_string(requests.size()) + " queries");
 
+        std::cout << "Budget exceeded: " << stats.budget_exceeded << " of " << requests.size()
+                  << ", latency p50/p95/p99/max (ms): " << stats.LatencyPercentile(50) << "/"
+                  << stats.LatencyPercentile(95) << "/" << stats.LatencyPercentile(99) << "/"
+                  << stats.LatencyPercentile(100) << std::endl;
+        logger.log("Budget exceeded: " + std::to_string(stats.budget_exceeded) +
+                   ", p99 latency ms: " + std::to_string(stats.LatencyPercentile(99)));
+
+        auto cache_stats = engine.GetCacheStats();
+        logger.log("Cache hits: results " + std::to_string(cache_stats.result_hits) + "/" +
+                   std::to_string(cache_stats.result_hits + cache_stats.result_misses) + ", intersections " +
+                   std::to_string(cache_stats.intersection_hits) + "/" +
+                   std::to_string(cache_stats.intersection_hits + cache_stats.intersection_misses));
+
         for (size_t i = 0; i < search_results.size(); ++i) {
-            std::cout << "Query '" << requests[i] << "': " << search_results[i].size() << " results" << std::endl;
-            logger.log("Query: " + requests[i] + " - " + std::to_string(search_results[i].size()) + " results");
+            std::cout << "Query '" << requests[i] << "': " << search_results[i].size() << " results"
+                      << (stats.partial[i] ? " (partial)" : "") << std::endl;
+            logger.log("Query: " + requests[i] + " - " + std::to_string(search_results[i].size()) + " results" +
+                       (stats.partial[i] ? " (partial)" : ""));
         }
 
         std::vector<std::vector<std::pair<int, float>>> answers;
@@ -89,7 +119,7 @@ int main(int argc, char **argv) {
             answers.push_back(query_answers);
         }
 
-        converter.putAnswers(answers);
+        converter.putAnswers(answers, stats.partial);
         std::cout << "Program completed successfully!" << std::endl;
         logger.log("Normal operation completed successfully");
 
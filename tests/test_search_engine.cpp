@@ -2,6 +2,11 @@
 #include "ConverterJSON.h"
 #include "InvertedIndex.h"
 #include "SearchServer.h"
+#include "SearchEngine.h"
+#include "DocumentStore.h"
+#include <cstdio>
+#include <algorithm>
+#include <fstream>
 
 TEST(InvertedIndexTest, BasicFunctionality) {
     const std::vector<std::string> docs = {
@@ -42,6 +47,16 @@ TEST(InvertedIndexTest, MultipleDocuments) {
     ASSERT_EQ(cappuccino_result.size(), 1);
 }
 
+TEST(InvertedIndexTest, FindPostingsReadsInPlace) {
+    InvertedIndex idx;
+    idx.UpdateDocumentBase({"milk water", "Milk milk"});
+
+    const auto& milk = idx.FindPostings("MILK");
+    EXPECT_EQ(milk, idx.GetWordCount("milk"));
+    EXPECT_EQ(&milk, &idx.FindPostings("milk"));
+    EXPECT_TRUE(idx.FindPostings("sugar").empty());
+}
+
 TEST(SearchServerTest, BasicSearch) {
     const std::vector<std::string> docs = {
         "milk milk milk milk water water water",
@@ -82,6 +97,242 @@ TEST(SearchServerTest, Ranking) {
     EXPECT_FLOAT_EQ(results[0][0].rank, 1.0f);
 }
 
+TEST(SearchServerTest, WorkBudgetReturnsPartialResults) {
+    const std::vector<std::string> docs = {
+        "milk milk milk milk water water water",
+        "milk water water",
+        "milk milk milk milk milk water water water water water",
+        "americano cappuccino"
+    };
+
+    InvertedIndex idx;
+    idx.UpdateDocumentBase(docs);
+    SearchServer server(idx);
+
+    SearchBudget budget;
+    budget.query_work_limit = 2;
+    auto partial_results = server.search({"milk water"}, budget);
+
+    ASSERT_EQ(server.GetLastStats().partial.size(), 1);
+    EXPECT_TRUE(server.GetLastStats().partial[0]);
+    EXPECT_EQ(server.GetLastStats().budget_exceeded, 1);
+    EXPECT_FALSE(partial_results[0].empty());
+    EXPECT_LT(partial_results[0].size(), 3);
+
+    auto full_results = server.search({"milk water"});
+    EXPECT_FALSE(server.GetLastStats().partial[0]);
+    EXPECT_EQ(server.GetLastStats().budget_exceeded, 0);
+    EXPECT_EQ(full_results[0].size(), 3);
+
+    for (const auto& result : partial_results[0]) {
+        auto found = std::find_if(full_results[0].begin(), full_results[0].end(),
+            [&](const RelativeIndex& expected) { return expected.doc_id == result.doc_id; });
+        EXPECT_NE(found, full_results[0].end());
+    }
+}
+
+TEST(SearchServerTest, PartialResultsMatchWholeQuery) {
+    const std::vector<std::string> docs = {
+        "rare",
+        "rare",
+        "rare common",
+        "common",
+        "common",
+        "common",
+        "common rare"
+    };
+    const std::string request = "rare common";
+
+    InvertedIndex idx;
+    idx.UpdateDocumentBase(docs);
+    SearchServer server(idx);
+    auto full = server.search({request});
+    ASSERT_EQ(full[0].size(), 2);
+
+    for (size_t work_limit = 1; work_limit <= 12; ++work_limit) {
+        SearchServer budgeted(idx);
+        SearchBudget budget;
+        budget.query_work_limit = work_limit;
+        auto partial = budgeted.search({request}, budget);
+
+        for (const auto& result : partial[0]) {
+            auto found = std::find_if(full[0].begin(), full[0].end(),
+                [&](const RelativeIndex& expected) { return expected.doc_id == result.doc_id; });
+            EXPECT_NE(found, full[0].end()) << "work limit " << work_limit << ", doc " << result.doc_id;
+        }
+        if (budgeted.GetLastStats().partial[0]) {
+            EXPECT_LT(partial[0].size(), full[0].size());
+        }
+    }
+}
+
+TEST(SearchServerTest, QueryDeadlineExpiry) {
+    QueryDeadline past(QueryDeadline::clock::now() - std::chrono::milliseconds(1), 0);
+    EXPECT_TRUE(past.Charge(0));
+
+    QueryDeadline unlimited(QueryDeadline::clock::time_point::max(), 0);
+    EXPECT_FALSE(unlimited.Charge(1000000));
+
+    QueryDeadline work(QueryDeadline::clock::time_point::max(), 10);
+    EXPECT_FALSE(work.Charge(10));
+    EXPECT_TRUE(work.Charge());
+    EXPECT_TRUE(work.Expired());
+}
+
+TEST(SearchServerTest, CacheKeyedOnTermSet) {
+    const std::vector<std::string> docs = {
+        "milk milk milk milk water water water",
+        "milk water water",
+        "milk milk milk milk milk water water water water water",
+        "americano cappuccino"
+    };
+
+    InvertedIndex idx;
+    idx.UpdateDocumentBase(docs);
+    SearchServer server(idx);
+
+    auto results = server.search({"milk water", "Water milk", "milk  water milk"});
+
+    EXPECT_EQ(results[1], results[0]);
+    EXPECT_EQ(results[2], results[0]);
+    EXPECT_EQ(server.GetCacheStats().result_hits, 2);
+    EXPECT_EQ(server.GetCacheStats().result_misses, 1);
+}
+
+TEST(SearchServerTest, CachedIntersectionPrefixIsReused) {
+    const std::vector<std::string> docs = {
+        "a b c e",
+        "a b c c e",
+        "a c e",
+        "c e"
+    };
+
+    InvertedIndex idx;
+    idx.UpdateDocumentBase(docs);
+    SearchServer server(idx);
+
+    server.search({"a b"});
+    EXPECT_EQ(server.GetCacheStats().intersection_hits, 0);
+
+    server.search({"a b c"});
+    EXPECT_EQ(server.GetCacheStats().intersection_hits, 0);
+    EXPECT_EQ(server.GetCacheStats().intersection_misses, 1);
+
+    auto results = server.search({"e c b a"});
+    EXPECT_EQ(server.GetCacheStats().intersection_hits, 1);
+    EXPECT_EQ(server.GetCacheStats().intersection_misses, 1);
+    EXPECT_EQ(results[0].size(), 2);
+
+    results = server.search({"c b a c"});
+    EXPECT_EQ(server.GetCacheStats().result_hits, 1);
+
+    const std::vector<RelativeIndex> expected = {{1, 1.0f}, {0, 0.75f}};
+    EXPECT_EQ(results[0], expected);
+}
+
+TEST(SearchServerTest, CacheInvalidatedOnUpdate) {
+    InvertedIndex idx;
+    idx.UpdateDocumentBase({"milk water", "sugar"});
+    SearchServer server(idx);
+
+    auto before = server.search({"sugar"});
+    ASSERT_EQ(before[0].size(), 1);
+    EXPECT_EQ(before[0][0].doc_id, 1);
+
+    idx.UpdateDocumentBase({"sugar", "milk water"});
+    auto after = server.search({"sugar"});
+    ASSERT_EQ(after[0].size(), 1);
+    EXPECT_EQ(after[0][0].doc_id, 0);
+    EXPECT_EQ(server.GetCacheStats().result_hits, 0);
+}
+
+TEST(SearchServerTest, CacheRespectsMemoryLimit) {
+    InvertedIndex idx;
+    idx.UpdateDocumentBase({"milk water", "milk sugar"});
+    SearchServer server(idx);
+    server.SetCacheLimits(0, 0);
+
+    server.search({"milk", "milk"});
+    EXPECT_EQ(server.GetCacheStats().result_hits, 0);
+    EXPECT_EQ(server.GetCacheStats().result_bytes, 0);
+}
+
+TEST(SearchEngineTest, VariantSelection) {
+    EXPECT_EQ(SelectIndexVariant(0, 0), IndexVariant::Compact16);
+    EXPECT_EQ(SelectIndexVariant(65536, 100000), IndexVariant::Compact16);
+    EXPECT_EQ(SelectIndexVariant(65537, 100000), IndexVariant::Compact32);
+    EXPECT_EQ(SelectIndexVariant(10, 200000), IndexVariant::Compact32);
+}
+
+TEST(SearchEngineTest, VariantsRankIdentically) {
+    const std::vector<std::string> docs = {
+        "milk milk milk milk water water water",
+        "milk water water",
+        "milk milk milk milk milk water water water water water",
+        "americano cappuccino"
+    };
+    const std::vector<std::string> requests = {"milk water", "water", "cappuccino", "sugar"};
+
+    InvertedIndex wide_index;
+    wide_index.UpdateDocumentBase(docs);
+    SearchServer wide_server(wide_index);
+    auto expected = wide_server.search(requests);
+
+    InvertedIndex16 compact_index;
+    compact_index.UpdateDocumentBase(docs);
+    BasicSearchServer<InvertedIndex16> compact_server(compact_index);
+    EXPECT_EQ(compact_server.search(requests), expected);
+
+    SearchEngine engine(docs);
+    EXPECT_EQ(engine.Variant(), IndexVariant::Compact16);
+    EXPECT_EQ(engine.search(requests), expected);
+}
+
+TEST(DocumentStoreTest, RoundTrip) {
+    const std::vector<std::vector<std::string>> corpora = {
+        {
+            "milk milk milk milk water water water",
+            "",
+            "americano cappuccino",
+            std::string(5000, 'a') + " repeated tail repeated tail repeated tail"
+        },
+        {"", ""},
+        {std::string(70000, 'x'), ""},
+        {"", std::string(70000, 'x'), "", "milk", ""}
+    };
+
+    const std::string path = "test_documents.store";
+    for (size_t block_size : {size_t(64), size_t(64 * 1024)}) {
+        for (const auto& docs : corpora) {
+            DocumentStore::Build(path, docs, block_size);
+            DocumentStore store(path);
+            ASSERT_EQ(store.size(), docs.size());
+            for (size_t i = 0; i < docs.size(); ++i) {
+                EXPECT_EQ(store.GetDocument(i), docs[i]) << "block size " << block_size << ", doc " << i;
+            }
+            EXPECT_THROW(store.GetDocument(docs.size()), std::out_of_range);
+        }
+    }
+    std::remove(path.c_str());
+}
+
+TEST(DocumentStoreTest, RejectsOversizedTables) {
+    const std::string path = "test_documents.store";
+    DocumentStore::Build(path, {"milk water"});
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        uint64_t block_count = uint64_t(1) << 60;
+        file.seekp(16);
+        file.write(reinterpret_cast<const char*>(&block_count), sizeof(block_count));
+    }
+    EXPECT_THROW(DocumentStore store(path), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(DocumentStoreTest, MissingFile) {
+    EXPECT_THROW(DocumentStore("missing_documents.store"), std::runtime_error);
+}
+
 TEST(ConverterJSONTest, ConfigValidation) {
     ConverterJSON converter;
     